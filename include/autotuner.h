@@ -0,0 +1,55 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include "execution_plan.h"
+#include "filter_chain.h"
+#include <map>
+#include <string>
+
+// Per-machine tuning profiles live next to the binary's working directory
+#define TUNING_FILE "ha_tuning.txt"
+
+// Time budget of one calibrated trial (repetitions are sized to fit it)
+#define TUNING_TRIAL_MS 50
+
+// Upper bound on worker threads accepted from a profile line
+#define MAX_PLAN_THREADS 256
+
+// How the pipeline drives the chain, beyond the passes themselves. Trials
+// reproduce it, and it is part of the profile key.
+struct TuningWorkload {
+    bool planar;        // Color path (processPlanar + runPlanes) instead of gray
+    bool holdLastBlur;  // Trailing blur runs only as the pyramid REDUCE (-pyramid-only)
+    bool stats;         // ISP and final DSP pass carry statistics taps
+    bool lut;           // Final DSP pass carries the auto-contrast LUT
+
+    TuningWorkload() : planar(false), holdLastBlur(false), stats(false), lut(false) {}
+
+    // Stable identifier, e.g. "gray", "gray+held", "gray+stats+lut", "color"
+    std::string key() const;
+};
+
+class AutoTuner {
+private:
+    std::string cpu;                               // Host CPU model
+    std::map<std::string, ExecutionPlan> profiles; // cpu \t WxH \t workload \t chain -> plan
+
+    std::string makeKey(int w, int h, const FilterChain& chain, const TuningWorkload& work) const;
+
+public:
+    AutoTuner();
+
+    const std::string& cpuModel() const { return cpu; }
+
+    // Profile store (all CPUs are kept, so one file can serve a whole fleet)
+    bool loadProfiles(const char* path);
+    bool saveProfiles(const char* path) const;
+    bool lookup(int w, int h, const FilterChain& chain, const TuningWorkload& work, ExecutionPlan& plan) const;
+
+    // Runs short timed trials of ColorConverter + chain on a synthetic frame
+    // for every candidate plan, records the fastest one and returns it.
+    // Trials run the chain the way `work` says the pipeline will.
+    ExecutionPlan tune(int w, int h, const FilterChain& chain, const TuningWorkload& work);
+};
+
+#endif
@@ -3,11 +3,23 @@
 
 #include "image_types.h"
 #include "buffer.h"
+#include "frame_stats.h"
+#include "execution_plan.h"
 #include <iostream>
 
 class ColorConverter {
+private:
+    ExecutionPlan plan; // Threading / stripe knobs
+    WorkerPool pool;    // Persistent workers that execute the plan
+
 public:
-    void process(FrameBuffer<Pixel>* input, FrameBuffer<GrayPixel>* output);
+    void setPlan(const ExecutionPlan& p) { plan = p; }
+
+    // Optional stats: luminance reductions fused into the conversion pass
+    void process(FrameBuffer<Pixel>* input, FrameBuffer<GrayPixel>* output, FrameStats* stats = nullptr);
+
+    // Color path: deinterleaves the 24-bit bus into R, G, B planes (SoA)
+    void processPlanar(FrameBuffer<Pixel>* input, FrameBuffer<GrayPixel>* const planes[3]);
 };
 
 #endif
\ No newline at end of file
@@ -4,14 +4,30 @@
 #include "image_types.h"
 #include "buffer.h"
 #include "kernel.h"
+#include "frame_stats.h"
+#include "execution_plan.h"
 #include <iostream>
 #include <cmath> // abs() works for ints too
 
 class ConvolutionEngine {
+private:
+    ExecutionPlan plan; // Threading / stripe / accumulator knobs
+    WorkerPool pool;    // Persistent workers that execute the plan
+
 public:
+    void setPlan(const ExecutionPlan& p) { plan = p; }
+
     // Standard Filter Process (Fixed Point or Float)
-    void process(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const Kernel& k);
-    void processSobel(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output);
+    // An optional OutputTap fuses statistics and a LUT into the pass write-back.
+    void process(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const Kernel& k, const OutputTap* tap = nullptr);
+    void processSobel(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const OutputTap* tap = nullptr);
+
+    // Planar Color Filter Process: same kernel on the R, G and B planes in one pass
+    void processPlanes(FrameBuffer<GrayPixel>* const input[3], FrameBuffer<GrayPixel>* const output[3], const Kernel& k);
+
+    // Rank-Order Filter over a size x size window (odd size, e.g. 3 or 5).
+    // rank 0 = min (erode), size*size/2 = median, size*size-1 = max (dilate).
+    void processRank(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, int size, int rank, const OutputTap* tap = nullptr);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef EXECUTION_PLAN_H
+#define EXECUTION_PLAN_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runtime knobs of the accelerator datapath (the "register map" a tuner writes).
+struct ExecutionPlan {
+    int threads;       // Parallel workers (replicated MAC arrays)
+    int stripeHeight;  // Rows per work item (0 = one even stripe per worker)
+    bool narrowAcc;    // Allow 16-bit accumulators when the analyzer proves they fit
+
+    ExecutionPlan() : threads(1), stripeHeight(0), narrowAcc(true) {}
+
+    // Number of private per-worker resources (e.g. stats accumulators) to allocate
+    int workerSlots() const { return threads > 1 ? threads : 1; }
+};
+
+// Persistent worker threads owned by an engine. Threads are spawned on
+// first use and then parked between passes, so a frame pays for thread
+// creation once instead of on every pass.
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)>* job;
+    unsigned generation;  // Bumped once per dispatched job
+    int activeWorkers;    // Workers taking part in the current job
+    int pending;          // Helper workers still running the current job
+    bool stopping;
+
+    void workerLoop(int id, unsigned seen);
+
+public:
+    WorkerPool() : job(nullptr), generation(0), activeWorkers(0), pending(0), stopping(false) {}
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs fn(id) for every id in [0, workers) and waits for all of them.
+    // Id 0 runs on the calling thread.
+    void run(int workers, const std::function<void(int)>& fn);
+};
+
+// Splits rows [y0, y1) into stripes and runs fn(stripeStart, stripeEnd, worker)
+// on up to plan.threads workers from `pool`. Stripes are handed out dynamically, so faster
+// workers pick up more of them. Worker ids are in [0, plan.threads).
+template <typename StripeFn>
+void runStripes(const ExecutionPlan& plan, WorkerPool& pool, int y0, int y1, StripeFn fn) {
+    int rows = y1 - y0;
+    if (rows <= 0) return;
+
+    int workers = std::max(plan.threads, 1);
+    int stripe = (plan.stripeHeight > 0) ? plan.stripeHeight : (rows + workers - 1) / workers;
+    int stripes = (rows + stripe - 1) / stripe;
+    workers = std::min(workers, stripes);
+
+    if (workers == 1) {
+        fn(y0, y1, 0);
+        return;
+    }
+
+    std::atomic<int> next(0);
+    auto worker = [&](int id) {
+        for (int s = next++; s < stripes; s = next++) {
+            int ys = y0 + s * stripe;
+            fn(ys, std::min(ys + stripe, y1), id);
+        }
+    };
+
+    pool.run(workers, worker);
+}
+
+#endif
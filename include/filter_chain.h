@@ -0,0 +1,45 @@
+#ifndef FILTER_CHAIN_H
+#define FILTER_CHAIN_H
+
+#include "image_types.h"
+#include "buffer.h"
+#include "convolution.h"
+#include "frame_stats.h"
+#include <string>
+
+// Stage-3 filter chain configuration (the sequence of DSP passes per frame)
+struct FilterChain {
+    int rankSize;    // Rank filter window (0 = disabled)
+    int rankIndex;   // Position in the sorted window
+    bool gaussian;
+    bool sharpen;
+    bool sobel;
+
+    FilterChain() : rankSize(0), rankIndex(0), gaussian(true), sharpen(true), sobel(true) {}
+
+    // Number of DSP passes (Box Blur is always on)
+    int passCount() const;
+
+    // Stable identifier, e.g. "blur+gaussian+sobel" (used to key tuning profiles)
+    std::string key() const;
+
+    // Kernel of the last pass when it is a smoothing blur (k_gaussian, or
+    // k_blur when nothing follows it), else null. A pyramid can run this
+    // pass as its first decimating REDUCE instead of at full resolution.
+    const Kernel* lastBlur() const;
+
+    // Runs every pass with ping-pong buffers. Takes ownership of `src` and
+    // returns the result frame. `finalTap` (may be null) rides on the last pass.
+    // With `holdLastBlur`, the lastBlur() pass is skipped (along with the
+    // tap) and the frame that would feed it is returned instead. If `spare`
+    // is given, the ping-pong buffer the skipped pass would have written is
+    // handed back (caller owns it) instead of being freed.
+    FrameBuffer<GrayPixel>* run(ConvolutionEngine& dsp, FrameBuffer<GrayPixel>* src, const OutputTap* finalTap,
+                                bool holdLastBlur = false, FrameBuffer<GrayPixel>** spare = nullptr) const;
+
+    // Color path: runs every pass on the R, G, B planes. Takes ownership of
+    // `planes` and replaces them with the result planes.
+    void runPlanes(ConvolutionEngine& dsp, FrameBuffer<GrayPixel>* planes[3]) const;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include "image_types.h"
+#include <cstdint>
+#include <iostream>
+
+// Per-frame luminance statistics (reduction results latched with the frame)
+struct FrameStats {
+    uint32_t histogram[256];
+    uint8_t minVal;
+    uint8_t maxVal;
+    uint64_t sum;
+    uint32_t count;   // Pixels actually produced by the pass (borders excluded)
+
+    FrameStats() { reset(); }
+    void reset();
+    void merge(const FrameStats& other);
+    double mean() const { return count ? (double)sum / count : 0.0; }
+};
+
+// ISP and final DSP statistics of one frame, carried down the pipeline
+struct FrameStatsRecord {
+    FrameStats isp;
+    FrameStats dsp;      // Final DSP pass, as tallied by its output tap (pre-LUT)
+    FrameStats written;  // `dsp` remapped through the LUT (valid if lutApplied)
+    bool lutApplied;
+
+    FrameStatsRecord() : lutApplied(false) {}
+};
+
+// Private reduction unit owned by one worker. Four interleaved histogram
+// banks keep neighbouring pixels with the same value from serializing on
+// one counter; banks are only merged when the pass is done.
+class StatsAccumulator {
+private:
+    uint32_t banks[4][256];
+    uint8_t minVal;
+    uint8_t maxVal;
+    uint64_t sum;
+    uint32_t count;
+
+public:
+    StatsAccumulator();
+    void tally(const GrayPixel* row, int n);
+    void flushInto(FrameStats& stats) const;
+};
+
+// Output tap of a DSP pass: reductions and an optional LUT are applied to each
+// output row while it is still hot in cache, instead of in extra frame sweeps.
+struct OutputTap {
+    FrameStats* stats;     // Pre-LUT statistics of the pass output (may be null)
+    const GrayPixel* lut;  // 256-entry remap applied on write-back (may be null)
+};
+
+// Tallies one finished output row into `acc`, then remaps it through the tap LUT
+void tapRow(GrayPixel* row, int n, const OutputTap* tap, StatsAccumulator& acc);
+
+// Contrast stretch between the 1st and 99th percentiles of `stats`
+void buildStretchLUT(const FrameStats& stats, GrayPixel lut[256]);
+
+// Exact statistics of the same pixels after remapping through `lut` (no frame sweep)
+void remapStats(const FrameStats& in, const GrayPixel lut[256], FrameStats& out);
+
+// Remaps the 1-pixel border ring a 3x3 pass leaves untouched, so the LUT covers the whole frame
+void remapBorder(GrayPixel* frame, int w, int h, const GrayPixel lut[256]);
+
+// One JSON object per frame
+void writeStatsJSON(std::ostream& os, int frame, const FrameStatsRecord& record);
+
+#endif
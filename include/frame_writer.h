@@ -8,6 +8,8 @@
 class FrameWriter {
 public:
     void writeBMP(const char* filename, FrameBuffer<GrayPixel>* buffer);
+    // 24-bit color output from planar R, G, B buffers
+    void writeBMP(const char* filename, FrameBuffer<GrayPixel>* const planes[3]);
 };
 
 #endif
\ No newline at end of file
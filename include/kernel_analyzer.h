@@ -0,0 +1,30 @@
+#ifndef KERNEL_ANALYZER_H
+#define KERNEL_ANALYZER_H
+
+#include "kernel.h"
+#include <cstdint>
+
+#ifdef USE_FIXED_POINT
+
+// Result of a load-time accumulator analysis.
+// In hardware, this sizes the MAC: a 16-bit accumulator fits twice as many
+// lanes in a SIMD register (or packs two MACs into one DSP slice).
+struct AccumulatorProfile {
+    Kernel effective;     // Kernel as loaded into the MAC (after exact rescaling)
+    int32_t accMin;       // Worst-case accumulator minimum (over any input frame)
+    int32_t accMax;       // Worst-case accumulator maximum
+    int bitsRequired;     // Signed bits needed to hold accMin..accMax
+    int accWidth;         // Selected accumulator width: 16, 32 or 0 (rejected)
+};
+
+class KernelAnalyzer {
+public:
+    // Computes the exact accumulator range of a kernel for 8-bit inputs.
+    // Weights sharing a power-of-two factor with the shift are rescaled first,
+    // which gives bit-identical results with a narrower accumulator.
+    AccumulatorProfile analyze(const Kernel& k) const;
+};
+
+#endif // USE_FIXED_POINT
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include "image_types.h"
+#include "buffer.h"
+#include "kernel.h"
+#include <iostream>
+#include <vector>
+
+class PyramidEngine {
+public:
+    // One REDUCE step: output is (w/2) x (h/2). The kernel is only evaluated
+    // at the retained (even) input positions, with clamp-to-edge borders.
+    void reduce(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const Kernel& k);
+
+    // Builds up to `levels` decimated frames (level n is (w >> n) x (h >> n)).
+    // Stops early once a level would collapse below 1 pixel. Caller owns the buffers.
+    // `first` (if given) replaces `k` for level 1, e.g. a blur held back from the chain.
+    // `firstLut` (if given) remaps level 1 as it is written, before deeper levels read it,
+    // just as the held pass's output LUT would have remapped the full frame.
+    std::vector<FrameBuffer<GrayPixel>*> process(FrameBuffer<GrayPixel>* input, int levels, const Kernel& k,
+                                                 const Kernel* first = nullptr, const GrayPixel* firstLut = nullptr);
+};
+
+#endif
@@ -0,0 +1,204 @@
+#include "autotuner.h"
+#include "color_converter.h"
+#include "frame_reader.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Reads the host CPU model (Linux). Tabs are reserved as field separators.
+static std::string detectCpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0 || line.compare(0, 8, "Hardware") == 0) {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+
+            std::string model = line.substr(colon + 1);
+            size_t start = model.find_first_not_of(" \t");
+            if (start == std::string::npos) continue;
+            model = model.substr(start);
+
+            for (size_t i = 0; i < model.size(); i++) {
+                if (model[i] == '\t') model[i] = ' ';
+            }
+            return model;
+        }
+    }
+    return "unknown-cpu";
+}
+
+AutoTuner::AutoTuner() : cpu(detectCpuModel()) {}
+
+std::string TuningWorkload::key() const {
+    std::string k = planar ? "color" : "gray";
+    if (holdLastBlur) k += "+held";
+    if (stats)        k += "+stats";
+    if (lut)          k += "+lut";
+    return k;
+}
+
+std::string AutoTuner::makeKey(int w, int h, const FilterChain& chain, const TuningWorkload& work) const {
+    return cpu + "\t" + std::to_string(w) + "x" + std::to_string(h) + "\t" + work.key() + "\t" + chain.key();
+}
+
+bool AutoTuner::loadProfiles(const char* path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    // Line format: cpu <TAB> WxH <TAB> workload <TAB> chain <TAB> threads stripe narrowAcc
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        size_t lastTab = line.rfind('\t');
+        if (lastTab == std::string::npos) continue;
+
+        ExecutionPlan plan;
+        int narrow = 1;
+        std::istringstream fields(line.substr(lastTab + 1));
+        if (!(fields >> plan.threads >> plan.stripeHeight >> narrow)) continue;
+        plan.narrowAcc = (narrow != 0);
+
+        // Corrupt or hand-edited entries must not spawn unbounded workers
+        if (plan.threads < 1 || plan.threads > MAX_PLAN_THREADS) continue;
+        if (plan.stripeHeight < 0 || plan.stripeHeight > MAX_HEIGHT) continue;
+
+        profiles[line.substr(0, lastTab)] = plan;
+    }
+    return true;
+}
+
+bool AutoTuner::saveProfiles(const char* path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Error: Could not write tuning file " << path << std::endl;
+        return false;
+    }
+
+    file << "# cpu\tresolution\tworkload\tchain\tthreads stripe narrowAcc" << std::endl;
+    for (std::map<std::string, ExecutionPlan>::const_iterator it = profiles.begin(); it != profiles.end(); ++it) {
+        file << it->first << "\t" << it->second.threads << " " << it->second.stripeHeight
+             << " " << (it->second.narrowAcc ? 1 : 0) << std::endl;
+    }
+    return true;
+}
+
+bool AutoTuner::lookup(int w, int h, const FilterChain& chain, const TuningWorkload& work, ExecutionPlan& plan) const {
+    std::map<std::string, ExecutionPlan>::const_iterator it = profiles.find(makeKey(w, h, chain, work));
+    if (it == profiles.end()) return false;
+
+    plan = it->second;
+
+    // A profile from a wider host of the same model never oversubscribes this one
+    int hw = (int)std::thread::hardware_concurrency();
+    if (hw >= 1 && plan.threads > hw) plan.threads = hw;
+    return true;
+}
+
+ExecutionPlan AutoTuner::tune(int w, int h, const FilterChain& chain, const TuningWorkload& work) {
+    // 1. SYNTHETIC STIMULUS
+    // Deterministic noise: every candidate sees the same frame, and noise
+    // defeats any data-dependent shortcut the real frame might allow.
+    FrameBuffer<Pixel> stimulus(w, h);
+    Pixel* raw = stimulus.getRawData();
+    uint32_t lfsr = 0x12345678u;
+    for (int i = 0; i < w * h; i++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        raw[i].r = (uint8_t)(lfsr >> 24);
+        raw[i].g = (uint8_t)(lfsr >> 16);
+        raw[i].b = (uint8_t)(lfsr >> 8);
+    }
+
+    // 2. CANDIDATE PLANS
+    int hw = (int)std::thread::hardware_concurrency();
+    if (hw < 1) hw = 1;
+
+    std::vector<int> threadOpts;
+    for (int t = 1; t < hw; t *= 2) threadOpts.push_back(t);
+    threadOpts.push_back(hw);
+
+    std::vector<ExecutionPlan> candidates;
+    for (size_t ti = 0; ti < threadOpts.size(); ti++) {
+        const int stripeOpts[] = { 0, 16, 64 };
+        int stripeCount = (threadOpts[ti] > 1) ? 3 : 1; // Stripes only matter with >1 worker
+
+        for (int si = 0; si < stripeCount; si++) {
+            ExecutionPlan plan;
+            plan.threads = threadOpts[ti];
+            plan.stripeHeight = stripeOpts[si];
+
+            #ifdef USE_FIXED_POINT
+            plan.narrowAcc = true;
+            candidates.push_back(plan);
+            plan.narrowAcc = false;
+            #endif
+            candidates.push_back(plan);
+        }
+    }
+
+    // 3. CALIBRATED TRIALS
+    typedef std::chrono::steady_clock Clock;
+    ColorConverter isp;
+    ConvolutionEngine dsp;
+
+    // Taps as the pipeline attaches them (an identity LUT costs the same as a stretch)
+    FrameStatsRecord trialStats;
+    GrayPixel trialLUT[256];
+    for (int i = 0; i < 256; i++) trialLUT[i] = (GrayPixel)i;
+    OutputTap trialTap = { work.stats ? &trialStats.dsp : nullptr, work.lut ? trialLUT : nullptr };
+
+    ExecutionPlan best;
+    double bestMs = -1.0;
+
+    for (size_t c = 0; c < candidates.size(); c++) {
+        isp.setPlan(candidates[c]);
+        dsp.setPlan(candidates[c]);
+
+        auto runOnce = [&]() -> double {
+            trialStats = FrameStatsRecord();
+            Clock::time_point t0 = Clock::now();
+            if (work.planar) {
+                FrameBuffer<GrayPixel>* planes[3];
+                for (int p = 0; p < 3; p++) planes[p] = new FrameBuffer<GrayPixel>(w, h);
+                isp.processPlanar(&stimulus, planes);
+                chain.runPlanes(dsp, planes);
+                for (int p = 0; p < 3; p++) delete planes[p];
+            } else {
+                FrameBuffer<GrayPixel>* gray = new FrameBuffer<GrayPixel>(w, h);
+                isp.process(&stimulus, gray, work.stats ? &trialStats.isp : nullptr);
+                delete chain.run(dsp, gray, &trialTap, work.holdLastBlur);
+            }
+            return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        };
+
+        // Warm-up run doubles as calibration: size repetitions to the budget
+        double warm = runOnce();
+        int reps = (warm > 0.0) ? (int)(TUNING_TRIAL_MS / warm) : 8;
+        if (reps < 1) reps = 1;
+        if (reps > 8) reps = 8;
+
+        // Best-of-N rejects scheduler noise
+        double trialMs = warm;
+        for (int r = 0; r < reps; r++) {
+            double ms = runOnce();
+            if (ms < trialMs) trialMs = ms;
+        }
+
+        #ifdef DEBUG
+        std::cout << " [TUNE] threads=" << candidates[c].threads << " stripe=" << candidates[c].stripeHeight
+                  << " narrow=" << candidates[c].narrowAcc << " : " << trialMs << " ms" << std::endl;
+        #endif
+
+        if (bestMs < 0.0 || trialMs < bestMs) {
+            bestMs = trialMs;
+            best = candidates[c];
+        }
+    }
+
+    profiles[makeKey(w, h, chain, work)] = best;
+    return best;
+}
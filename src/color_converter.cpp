@@ -1,12 +1,13 @@
 #include "color_converter.h"
 #include <iostream>
+#include <vector>
 
 // Default to Fixed Point if nothing is defined (Safety)
 #if !defined(USE_FIXED_POINT) && !defined(USE_FLOAT)
 #define USE_FIXED_POINT
 #endif
 
-void ColorConverter::process(FrameBuffer<Pixel>* input, FrameBuffer<GrayPixel>* output) {
+void ColorConverter::process(FrameBuffer<Pixel>* input, FrameBuffer<GrayPixel>* output, FrameStats* stats) {
     // Input: RGB Buffer (3 bytes)
     // Output: Grayscale Buffer (1 byte)     
     int width = input->getWidth();
@@ -26,43 +27,91 @@ void ColorConverter::process(FrameBuffer<Pixel>* input, FrameBuffer<GrayPixel>*
     #endif
     #endif
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
+    // One private reduction unit per worker, merged once the frame is done
+    std::vector<StatsAccumulator> accs(plan.workerSlots());
+
+    runStripes(plan, pool, 0, height, [&](int ys, int ye, int worker) {
+        for (int y = ys; y < ye; y++) {
+            for (int x = 0; x < width; x++) {
             
-            // 1. FETCH (Read from Input Memory)
-            Pixel p = input->getPixel(x, y);
+                // 1. FETCH (Read from Input Memory)
+                Pixel p = input->getPixel(x, y);
 
-            #ifdef USE_FIXED_POINT
-                // --- FIXED POINT MODE (Hardware) ---
-                // Math: Q8.8 format. 
-                // Coefficients scaled by 256. 
-                // 0.299 * 256 = 77
-                // 0.587 * 256 = 150
-                // 0.114 * 256 = 29
-                // Sum = 256 (Perfect power of 2)
+                #ifdef USE_FIXED_POINT
+                    // --- FIXED POINT MODE (Hardware) ---
+                    // Math: Q8.8 format. 
+                    // Coefficients scaled by 256. 
+                    // 0.299 * 256 = 77
+                    // 0.587 * 256 = 150
+                    // 0.114 * 256 = 29
+                    // Sum = 256 (Perfect power of 2)
                 
-                int32_t gray_accum = (77 * p.r) + (150 * p.g) + (29 * p.b);
+                    int32_t gray_accum = (77 * p.r) + (150 * p.g) + (29 * p.b);
                 
-                // Shift right by 8 (Divide by 256)
-                uint8_t gray = (uint8_t)(gray_accum >> 8);
+                    // Shift right by 8 (Divide by 256)
+                    uint8_t gray = (uint8_t)(gray_accum >> 8);
                 
-                output->setPixel(x, y, gray);
+                    output->setPixel(x, y, gray);
 
-            #else
-                // --- FLOATING POINT MODE (Verification) ---
-                // Standard Luma Formula
-                float gray_f = (0.299f * p.r) + (0.587f * p.g) + (0.114f * p.b);
+                #else
+                    // --- FLOATING POINT MODE (Verification) ---
+                    // Standard Luma Formula
+                    float gray_f = (0.299f * p.r) + (0.587f * p.g) + (0.114f * p.b);
                 
-                // Clamp and Cast
-                if (gray_f > 255.0f) gray_f = 255.0f;
-                if (gray_f < 0.0f)   gray_f = 0.0f;
+                    // Clamp and Cast
+                    if (gray_f > 255.0f) gray_f = 255.0f;
+                    if (gray_f < 0.0f)   gray_f = 0.0f;
                 
-                output->setPixel(x, y, (uint8_t)gray_f);
-            #endif
+                    output->setPixel(x, y, (uint8_t)gray_f);
+                #endif
+            }
+
+            // Reduce the finished row while it is still in cache
+            if (stats) {
+                accs[worker].tally(output->getRawData() + y * width, width);
+            }
+        }
+    });
+
+    if (stats) {
+        for (size_t i = 0; i < accs.size(); i++) {
+            accs[i].flushInto(*stats);
         }
     }
     
     #ifdef DEBUG
     std::cout << " [ISP] Conversion Complete." << std::endl;
     #endif
+}
+
+void ColorConverter::processPlanar(FrameBuffer<Pixel>* input, FrameBuffer<GrayPixel>* const planes[3]) {
+    int width = input->getWidth();
+    int height = input->getHeight();
+
+    // Hardware Constraint Check
+    for (int c = 0; c < 3; c++) {
+        if (planes[c]->getWidth() != width || planes[c]->getHeight() != height) {
+            std::cerr << "Error: Buffer dimensions mismatch!" << std::endl;
+            return;
+        }
+    }
+
+    #ifdef DEBUG
+    std::cout << " [ISP] Planar Split (RGB -> R | G | B)..." << std::endl;
+    #endif
+
+    const Pixel* src = input->getRawData();
+    GrayPixel* r = planes[0]->getRawData();
+    GrayPixel* g = planes[1]->getRawData();
+    GrayPixel* b = planes[2]->getRawData();
+
+    // AoS -> SoA: after this, every plane is a dense 8-bit stream that the
+    // DSP engine can filter with the same SIMD datapath as grayscale
+    runStripes(plan, pool, 0, height, [&](int ys, int ye, int worker) {
+        for (int i = ys * width; i < ye * width; i++) {
+            r[i] = src[i].r;
+            g[i] = src[i].g;
+            b[i] = src[i].b;
+        }
+    });
 }
\ No newline at end of file
@@ -1,75 +1,220 @@
 #include "convolution.h"
+#include "kernel_analyzer.h"
 #include <iostream>
 #include <cmath> // abs() works for ints too
+#include <vector>
+#include <algorithm>
+#include <cstring>
 
-void ConvolutionEngine::process(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const Kernel& k) {
-        int w = input->getWidth();
+// Merges the private per-worker reductions into the tap's frame statistics
+static void flushTap(const OutputTap* tap, const std::vector<StatsAccumulator>& accs) {
+    if (!tap || !tap->stats) return;
+    for (size_t i = 0; i < accs.size(); i++) {
+        accs[i].flushInto(*tap->stats);
+    }
+}
+
+#ifdef USE_FIXED_POINT
+// MAC array for one kernel, templated on the accumulator width.
+// Reads whole rows straight from BRAM so the compiler can map the x loop onto
+// SIMD lanes: an int16_t accumulator packs twice as many lanes as int32_t.
+template <typename AccT>
+static void macRows(const GrayPixel* in, GrayPixel* out, int w, int y0, int y1, const Kernel& k,
+                    const OutputTap* tap, StatsAccumulator& acc) {
+    // Latch the coefficient registers into locals: the byte stores below
+    // could otherwise alias the caller's Kernel and block vectorization
+    int16_t wgt[3][3];
+    for (int ky = 0; ky < 3; ky++) {
+        for (int kx = 0; kx < 3; kx++) {
+            wgt[ky][kx] = k.weights[ky][kx];
+        }
+    }
+    const int shift = k.shift;
+    const AccT bias = (AccT)k.bias;
+
+    for (int y = y0; y < y1; y++) {
+        const GrayPixel* rows[3] = { in + (y - 1) * w, in + y * w, in + (y + 1) * w };
+        GrayPixel* dstRow = out + y * w;
+
+        for (int x = 1; x < w - 1; x++) {
+            AccT sum = 0;
+
+            for (int ky = 0; ky < 3; ky++) {
+                for (int kx = 0; kx < 3; kx++) {
+                    sum += (AccT)(rows[ky][x + kx - 1] * wgt[ky][kx]);
+                }
+            }
+
+            // Apply Bit Shift (Hardware Division)
+            if (shift > 0) {
+                sum = (AccT)(sum >> shift);
+            }
+
+            sum += bias;
+
+            // Clamp
+            if (sum < 0) sum = 0;
+            if (sum > 255) sum = 255;
+
+            dstRow[x] = (uint8_t)sum;
+        }
+
+        tapRow(dstRow + 1, w - 2, tap, acc);
+    }
+}
+#else
+// Floating-point reference MAC (verification model, not vectorized)
+static void floatRows(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, int y0, int y1, const Kernel& k,
+                      const OutputTap* tap, StatsAccumulator& acc) {
+    int w = input->getWidth();
+
+    for (int y = y0; y < y1; y++) {
+        for (int x = 1; x < w - 1; x++) {
+            // --- FLOATING POINT MODE ---
+            float sum = 0.0f;
+
+            for (int ky = -1; ky <= 1; ky++) {
+                for (int kx = -1; kx <= 1; kx++) {
+                    uint8_t val = input->getPixel(x + kx, y + ky);
+                    sum += (float)val * k.weights[ky + 1][kx + 1];
+                }
+            }
+
+            // Apply Scale (Float Multiply)
+            sum = (sum * k.scale) + k.bias;
+
+            // Clamp
+            if (sum < 0.0f) sum = 0.0f;
+            if (sum > 255.0f) sum = 255.0f;
+
+            output->setPixel(x, y, (uint8_t)sum);
+        }
+
+        tapRow(output->getRawData() + y * w + 1, w - 2, tap, acc);
+    }
+}
+#endif
+
+void ConvolutionEngine::process(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const Kernel& k, const OutputTap* tap) {
         int h = input->getHeight();
-        
-        #ifdef DEBUG
+        std::vector<StatsAccumulator> accs(plan.workerSlots());
+
         #ifdef USE_FIXED_POINT
-            std::cout << " [DSP] Fixed-Point Convolution..." << std::endl;
+            // --- FIXED POINT MODE ---
+            // Size the accumulator from the kernel's worst-case range
+            KernelAnalyzer analyzer;
+            AccumulatorProfile profile = analyzer.analyze(k);
+
+            if (profile.accWidth == 0) {
+                std::cerr << "DSP Error: Kernel accumulator exceeds 32 bits!" << std::endl;
+                return;
+            }
+
+            // The plan may pin the MAC to 32 bits even when 16 would fit
+            bool narrow = (profile.accWidth == 16) && plan.narrowAcc;
+
+            #ifdef DEBUG
+            std::cout << " [DSP] Fixed-Point Convolution (" << (narrow ? 16 : 32)
+                      << "-bit accumulator)..." << std::endl;
+            #endif
+
+            int w = input->getWidth();
+            const GrayPixel* in = input->getRawData();
+            GrayPixel* out = output->getRawData();
+
+            runStripes(plan, pool, 1, h - 1, [&](int ys, int ye, int worker) {
+                if (narrow) {
+                    macRows<int16_t>(in, out, w, ys, ye, profile.effective, tap, accs[worker]);
+                } else {
+                    macRows<int32_t>(in, out, w, ys, ye, profile.effective, tap, accs[worker]);
+                }
+            });
+
         #else
+            #ifdef DEBUG
             std::cout << " [DSP] Floating-Point Convolution..." << std::endl;
-        #endif
+            #endif
+
+            runStripes(plan, pool, 1, h - 1, [&](int ys, int ye, int worker) {
+                floatRows(input, output, ys, ye, k, tap, accs[worker]);
+            });
         #endif
 
-        for (int y = 1; y < h - 1; y++) {
-            for (int x = 1; x < w - 1; x++) {
-                
-                #ifdef USE_FIXED_POINT
-                    // --- FIXED POINT MODE ---
-                    // Use 32-bit int accumulator to prevent overflow
-                    int32_t sum = 0;
-
-                    for (int ky = -1; ky <= 1; ky++) {
-                        for (int kx = -1; kx <= 1; kx++) {
-                            uint8_t val = input->getPixel(x + kx, y + ky);
-                            sum += (int16_t)val * k.weights[ky + 1][kx + 1];
-                        }
-                    }
+        flushTap(tap, accs);
+    }
 
-                    // Apply Bit Shift (Hardware Division)
-                    if (k.shift > 0) {
-                        sum = sum >> k.shift; 
-                    }
-                    
-                    sum += k.bias;
+    // Planar Color Filter Process (Fixed Point or Float)
+    void ConvolutionEngine::processPlanes(FrameBuffer<GrayPixel>* const input[3], FrameBuffer<GrayPixel>* const output[3], const Kernel& k) {
+        int h = input[0]->getHeight();
 
-                    // Clamp
-                    if (sum < 0) sum = 0;
-                    if (sum > 255) sum = 255;
+        for (int c = 1; c < 3; c++) {
+            if (input[c]->getWidth() != input[0]->getWidth() || input[c]->getHeight() != h) {
+                std::cerr << "Error: Color plane dimensions mismatch!" << std::endl;
+                return;
+            }
+        }
 
-                    output->setPixel(x, y, (uint8_t)sum);
+        #ifdef USE_FIXED_POINT
+            // --- FIXED POINT MODE ---
+            // One analysis for all three planes: they share the same MAC configuration
+            KernelAnalyzer analyzer;
+            AccumulatorProfile profile = analyzer.analyze(k);
+
+            if (profile.accWidth == 0) {
+                std::cerr << "DSP Error: Kernel accumulator exceeds 32 bits!" << std::endl;
+                return;
+            }
 
-                #else
-                    // --- FLOATING POINT MODE ---
-                    float sum = 0.0f;
+            bool narrow = (profile.accWidth == 16) && plan.narrowAcc;
 
-                    for (int ky = -1; ky <= 1; ky++) {
-                        for (int kx = -1; kx <= 1; kx++) {
-                            uint8_t val = input->getPixel(x + kx, y + ky);
-                            sum += (float)val * k.weights[ky + 1][kx + 1];
+            #ifdef DEBUG
+            std::cout << " [DSP] Fixed-Point Planar Convolution (" << (narrow ? 16 : 32)
+                      << "-bit accumulator)..." << std::endl;
+            #endif
+
+            int w = input[0]->getWidth();
+
+            runStripes(plan, pool, 1, h - 1, [&](int ys, int ye, int worker) {
+                StatsAccumulator idle; // Color passes carry no output tap
+
+                // Planes are interleaved row by row: the R, G and B line
+                // buffers of a row are filtered back to back while hot in cache
+                for (int y = ys; y < ye; y++) {
+                    for (int c = 0; c < 3; c++) {
+                        const GrayPixel* in = input[c]->getRawData();
+                        GrayPixel* out = output[c]->getRawData();
+
+                        if (narrow) {
+                            macRows<int16_t>(in, out, w, y, y + 1, profile.effective, nullptr, idle);
+                        } else {
+                            macRows<int32_t>(in, out, w, y, y + 1, profile.effective, nullptr, idle);
                         }
                     }
+                }
+            });
 
-                    // Apply Scale (Float Multiply)
-                    sum = (sum * k.scale) + k.bias;
+        #else
+            #ifdef DEBUG
+            std::cout << " [DSP] Floating-Point Planar Convolution..." << std::endl;
+            #endif
 
-                    // Clamp
-                    if (sum < 0.0f) sum = 0.0f;
-                    if (sum > 255.0f) sum = 255.0f;
+            runStripes(plan, pool, 1, h - 1, [&](int ys, int ye, int worker) {
+                StatsAccumulator idle; // Color passes carry no output tap
 
-                    output->setPixel(x, y, (uint8_t)sum);
-                #endif
-            }
-        }
+                for (int y = ys; y < ye; y++) {
+                    for (int c = 0; c < 3; c++) {
+                        floatRows(input[c], output[c], y, y + 1, k, nullptr, idle);
+                    }
+                }
+            });
+        #endif
     }
 
     // Sobel Magnitude (Fixed Point or Float)
-    void ConvolutionEngine::processSobel(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output) {
+    void ConvolutionEngine::processSobel(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const OutputTap* tap) {
         int w = input->getWidth();
         int h = input->getHeight();
+        std::vector<StatsAccumulator> accs(plan.workerSlots());
         
         #ifdef DEBUG
         #ifdef USE_FIXED_POINT
@@ -79,47 +224,260 @@ void ConvolutionEngine::process(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayP
         #endif
         #endif
         
-        for (int y = 1; y < h - 1; y++) {
-            for (int x = 1; x < w - 1; x++) {
+        runStripes(plan, pool, 1, h - 1, [&](int ys, int ye, int worker) {
+            for (int y = ys; y < ye; y++) {
+                for (int x = 1; x < w - 1; x++) {
                 
-                #ifdef USE_FIXED_POINT
-                    // --- FIXED POINT MODE ---
-                    int32_t sumX = 0;
-                    int32_t sumY = 0;
-
-                    for (int ky = -1; ky <= 1; ky++) {
-                        for (int kx = -1; kx <= 1; kx++) {
-                            uint8_t val = input->getPixel(x + kx, y + ky);
-                            sumX += (int16_t)val * k_sobel_x.weights[ky + 1][kx + 1];
-                            sumY += (int16_t)val * k_sobel_y.weights[ky + 1][kx + 1];
+                    #ifdef USE_FIXED_POINT
+                        // --- FIXED POINT MODE ---
+                        int32_t sumX = 0;
+                        int32_t sumY = 0;
+
+                        for (int ky = -1; ky <= 1; ky++) {
+                            for (int kx = -1; kx <= 1; kx++) {
+                                uint8_t val = input->getPixel(x + kx, y + ky);
+                                sumX += (int16_t)val * k_sobel_x.weights[ky + 1][kx + 1];
+                                sumY += (int16_t)val * k_sobel_y.weights[ky + 1][kx + 1];
+                            }
                         }
-                    }
 
-                    // Hardware Magnitude: |x| + |y|
-                    int32_t mag = std::abs(sumX) + std::abs(sumY);
+                        // Hardware Magnitude: |x| + |y|
+                        int32_t mag = std::abs(sumX) + std::abs(sumY);
 
-                    if (mag > 255) mag = 255;
-                    output->setPixel(x, y, (uint8_t)mag);
+                        if (mag > 255) mag = 255;
+                        output->setPixel(x, y, (uint8_t)mag);
 
-                #else
-                    // --- FLOATING POINT MODE ---
-                    float sumX = 0.0f;
-                    float sumY = 0.0f;
+                    #else
+                        // --- FLOATING POINT MODE ---
+                        float sumX = 0.0f;
+                        float sumY = 0.0f;
 
-                    for (int ky = -1; ky <= 1; ky++) {
-                        for (int kx = -1; kx <= 1; kx++) {
-                            uint8_t val = input->getPixel(x + kx, y + ky);
-                            sumX += (float)val * k_sobel_x.weights[ky + 1][kx + 1];
-                            sumY += (float)val * k_sobel_y.weights[ky + 1][kx + 1];
+                        for (int ky = -1; ky <= 1; ky++) {
+                            for (int kx = -1; kx <= 1; kx++) {
+                                uint8_t val = input->getPixel(x + kx, y + ky);
+                                sumX += (float)val * k_sobel_x.weights[ky + 1][kx + 1];
+                                sumY += (float)val * k_sobel_y.weights[ky + 1][kx + 1];
+                            }
                         }
+
+                        // Standard Magnitude: |x| + |y| (Or sqrt(x^2 + y^2))
+                        float mag = std::abs(sumX) + std::abs(sumY);
+
+                        if (mag > 255.0f) mag = 255.0f;
+                        output->setPixel(x, y, (uint8_t)mag);
+                    #endif
+                }
+
+                tapRow(output->getRawData() + y * w + 1, w - 2, tap, accs[worker]);
+            }
+        });
+
+        flushTap(tap, accs);
+    };
+
+// --- RANK-ORDER FILTERS (Sorting Networks) ---
+// A sorting network is a fixed sequence of compare-exchange (min/max) cells,
+// so every output pixel of a row runs the exact same data-independent
+// schedule: one min/max per cell across the whole row, which maps directly
+// onto SIMD lanes (or a systolic comparator array in hardware).
+
+// One comparator cell. Pruned cells only drive the output that is used.
+struct RankOp {
+    enum Kind { SWAP, MIN_ONLY, MAX_ONLY };
+    int lo;    // Receives the minimum
+    int hi;    // Receives the maximum
+    Kind kind;
+};
+
+static const int RANK_INF = -1; // Virtual +infinity padding wire
+
+// Batcher odd-even merge sort over N = 2^m logical wires, starting at merge
+// width pStart (blocks of pStart wires are assumed sorted already).
+// wireSlot maps logical wires to storage slots; padding wires hold +inf and
+// are never stored: a comparator against +inf is a no-op or a relabel.
+static void batcherNetwork(std::vector<int>& wireSlot, int pStart, std::vector<RankOp>& ops) {
+    int n = (int)wireSlot.size();
+
+    for (int p = pStart; p < n; p += p) {
+        for (int k = p; k > 0; k /= 2) {
+            for (int j = k % p; j <= n - 1 - k; j += 2 * k) {
+                for (int i = 0; i <= std::min(k - 1, n - j - k - 1); i++) {
+                    if ((i + j) / (2 * p) != (i + j + k) / (2 * p)) continue;
+
+                    int a = i + j;
+                    int b = i + j + k;
+                    if (wireSlot[b] == RANK_INF) continue; // min(x, inf) = x
+                    if (wireSlot[a] == RANK_INF) {        // inf moves up: relabel
+                        wireSlot[a] = wireSlot[b];
+                        wireSlot[b] = RANK_INF;
+                        continue;
                     }
 
-                    // Standard Magnitude: |x| + |y| (Or sqrt(x^2 + y^2))
-                    float mag = std::abs(sumX) + std::abs(sumY);
+                    RankOp op = { wireSlot[a], wireSlot[b], RankOp::SWAP };
+                    ops.push_back(op);
+                }
+            }
+        }
+    }
+}
+
+// Backward pass: drops cells that cannot reach a needed slot and turns cells
+// with one live output into a single min or max. `needed` holds the live
+// output slots on entry and the live input slots on return.
+static void pruneNetwork(std::vector<RankOp>& ops, std::vector<bool>& needed) {
+    std::vector<RankOp> kept;
 
-                    if (mag > 255.0f) mag = 255.0f;
-                    output->setPixel(x, y, (uint8_t)mag);
-                #endif
+    for (int i = (int)ops.size() - 1; i >= 0; i--) {
+        RankOp op = ops[i];
+        bool needLo = needed[op.lo];
+        bool needHi = needed[op.hi];
+        if (!needLo && !needHi) continue;
+
+        if (!needHi)      op.kind = RankOp::MIN_ONLY;
+        else if (!needLo) op.kind = RankOp::MAX_ONLY;
+
+        needed[op.lo] = needed[op.hi] = true;
+        kept.push_back(op);
+    }
+
+    ops.assign(kept.rbegin(), kept.rend());
+}
+
+// Runs a comparator schedule across `n` lanes (one lane per output pixel)
+static void runNetwork(const std::vector<RankOp>& ops, GrayPixel* slots, int stride, int n) {
+    for (size_t i = 0; i < ops.size(); i++) {
+        GrayPixel* lo = slots + ops[i].lo * stride;
+        GrayPixel* hi = slots + ops[i].hi * stride;
+
+        switch (ops[i].kind) {
+            case RankOp::SWAP:
+                for (int x = 0; x < n; x++) {
+                    GrayPixel a = lo[x];
+                    GrayPixel b = hi[x];
+                    lo[x] = (a < b) ? a : b;
+                    hi[x] = (a < b) ? b : a;
+                }
+                break;
+            case RankOp::MIN_ONLY:
+                for (int x = 0; x < n; x++) lo[x] = std::min(lo[x], hi[x]);
+                break;
+            case RankOp::MAX_ONLY:
+                for (int x = 0; x < n; x++) hi[x] = std::max(lo[x], hi[x]);
+                break;
+        }
+    }
+}
+
+// Passes the `radius`-wide ring that no window fully covers straight through,
+// so the next pass never reads unwritten (zero) pixels at the frame edge
+static void copyBorder(const GrayPixel* in, GrayPixel* out, int w, int h, int radius) {
+    for (int y = 0; y < h; y++) {
+        if (y < radius || y >= h - radius) {
+            std::memcpy(out + y * w, in + y * w, w);
+            continue;
+        }
+        int edge = std::min(radius, w);
+        std::memcpy(out + y * w, in + y * w, edge);
+        std::memcpy(out + y * w + w - edge, in + y * w + w - edge, edge);
+    }
+}
+
+static int nextPow2(int v) {
+    int p = 1;
+    while (p < v) p += p;
+    return p;
+}
+
+void ConvolutionEngine::processRank(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, int size, int rank, const OutputTap* tap) {
+    int w = input->getWidth();
+    int h = input->getHeight();
+    int taps = size * size;
+    int radius = size / 2;
+
+    if (size < 3 || size % 2 == 0 || rank < 0 || rank >= taps) {
+        std::cerr << "DSP Error: Invalid rank filter (" << size << "x" << size << ", rank " << rank << ")!" << std::endl;
+        return;
+    }
+    if (w < size || h < size) {
+        copyBorder(input->getRawData(), output->getRawData(), w, h, std::max(w, h)); // No complete window: all ring
+        return;
+    }
+
+    #ifdef DEBUG
+    std::cout << " [DSP] Rank Filter " << size << "x" << size << " (rank " << rank << ")..." << std::endl;
+    #endif
+
+    // 1. COLUMN SORT NETWORK
+    // Sorts the `size` pixels of one column. Every column is shared by `size`
+    // neighbouring windows, so it is sorted once per row and reused.
+    std::vector<int> colWire(nextPow2(size), RANK_INF);
+    for (int j = 0; j < size; j++) colWire[j] = j;
+    std::vector<RankOp> colOps;
+    batcherNetwork(colWire, 1, colOps);
+
+    // 2. WINDOW MERGE NETWORK
+    // Logical wire c*P + j is the j-th smallest pixel of column c, with each
+    // column padded to P wires. Batcher's merge stages from width P upward
+    // finish the sort; the column-sort stages below P are already done.
+    int colPad = nextPow2(size);
+    std::vector<int> winWire(nextPow2(size) * colPad, RANK_INF);
+    for (int c = 0; c < size; c++) {
+        for (int j = 0; j < size; j++) winWire[c * colPad + j] = c * size + j;
+    }
+    std::vector<RankOp> winOps;
+    batcherNetwork(winWire, colPad, winOps);
+
+    // Only the requested rank leaves the accelerator: prune everything else
+    std::vector<bool> winNeeded(taps, false);
+    winNeeded[winWire[rank]] = true;
+    pruneNetwork(winOps, winNeeded);
+
+    // Column outputs that any window slot still reads
+    std::vector<bool> colSlotNeeded(size, false);
+    for (int c = 0; c < size; c++) {
+        for (int j = 0; j < size; j++) {
+            if (winNeeded[c * size + j]) colSlotNeeded[colWire[j]] = true;
+        }
+    }
+    pruneNetwork(colOps, colSlotNeeded);
+
+    // 3. STREAM ROWS THROUGH THE NETWORKS
+    int lanes = w - size + 1;  // Output pixels per row
+    GrayPixel* in = input->getRawData();
+    GrayPixel* out = output->getRawData();
+    std::vector<StatsAccumulator> accs(plan.workerSlots());
+
+    // Private column/window buffers per worker, allocated once per pass
+    std::vector<std::vector<GrayPixel> > colBufs(plan.workerSlots(), std::vector<GrayPixel>(size * w));
+    std::vector<std::vector<GrayPixel> > winBufs(plan.workerSlots(), std::vector<GrayPixel>(taps * lanes));
+
+    copyBorder(in, out, w, h, radius);
+
+    runStripes(plan, pool, radius, h - radius, [&](int ys, int ye, int worker) {
+        std::vector<GrayPixel>& colBuf = colBufs[worker];
+        std::vector<GrayPixel>& winBuf = winBufs[worker];
+
+        for (int y = ys; y < ye; y++) {
+            // Load and sort every column of the window band
+            for (int j = 0; j < size; j++) {
+                std::memcpy(&colBuf[j * w], in + (y - radius + j) * w, w);
+            }
+            runNetwork(colOps, colBuf.data(), w, w);
+
+            // Window slot (c, j) of output lane x is sorted column x + c, rank j
+            for (int c = 0; c < size; c++) {
+                for (int j = 0; j < size; j++) {
+                    int slot = c * size + j;
+                    if (!winNeeded[slot]) continue;
+                    std::memcpy(&winBuf[slot * lanes], &colBuf[colWire[j] * w + c], lanes);
+                }
             }
+            runNetwork(winOps, winBuf.data(), lanes, lanes);
+
+            std::memcpy(out + y * w + radius, &winBuf[winWire[rank] * lanes], lanes);
+            tapRow(out + y * w + radius, lanes, tap, accs[worker]);
         }
-    };
+    });
+
+    flushTap(tap, accs);
+}
@@ -0,0 +1,61 @@
+#include "execution_plan.h"
+
+WorkerPool::~WorkerPool() {
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+void WorkerPool::workerLoop(int id, unsigned seen) {
+    std::unique_lock<std::mutex> guard(lock);
+
+    while (true) {
+        wake.wait(guard, [&]() { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+
+        // Parked workers beyond the current width skip this job
+        if (id >= activeWorkers) continue;
+
+        const std::function<void(int)>* fn = job;
+        guard.unlock();
+        (*fn)(id);
+        guard.lock();
+
+        if (--pending == 0) done.notify_one();
+    }
+}
+
+void WorkerPool::run(int workers, const std::function<void(int)>& fn) {
+    if (workers <= 1) {
+        fn(0);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        // Grow lazily: the calling thread is worker 0
+        while ((int)threads.size() < workers - 1) {
+            threads.push_back(std::thread(&WorkerPool::workerLoop, this, (int)threads.size() + 1, generation));
+        }
+
+        job = &fn;
+        activeWorkers = workers;
+        pending = workers - 1;
+        generation++;
+    }
+    wake.notify_all();
+
+    fn(0);
+
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [&]() { return pending == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,115 @@
+#include "filter_chain.h"
+#include "kernel.h"
+#include <algorithm> // For std::swap
+
+int FilterChain::passCount() const {
+    return (rankSize > 0) + 1 + gaussian + sharpen + sobel;
+}
+
+std::string FilterChain::key() const {
+    std::string k;
+    if (rankSize > 0) {
+        k += "rank" + std::to_string(rankSize) + "_" + std::to_string(rankIndex) + "+";
+    }
+    k += "blur";
+    if (gaussian) k += "+gaussian";
+    if (sharpen)  k += "+sharpen";
+    if (sobel)    k += "+sobel";
+    return k;
+}
+
+const Kernel* FilterChain::lastBlur() const {
+    if (sharpen || sobel) return nullptr;
+    return gaussian ? &k_gaussian : &k_blur;
+}
+
+FrameBuffer<GrayPixel>* FilterChain::run(ConvolutionEngine& dsp, FrameBuffer<GrayPixel>* src, const OutputTap* finalTap,
+                                         bool holdLastBlur, FrameBuffer<GrayPixel>** spare) const {
+    const Kernel* held = holdLastBlur ? lastBlur() : nullptr;
+
+    // Ping-pong buffer management within the accelerator
+    FrameBuffer<GrayPixel>* dst = new FrameBuffer<GrayPixel>(src->getWidth(), src->getHeight());
+
+    int passesLeft = passCount();
+    auto tapFor = [&]() -> const OutputTap* {
+        return (--passesLeft == 0) ? finalTap : nullptr;
+    };
+
+    // Impulse Noise Removal (Rank Filter runs before any averaging)
+    if (rankSize > 0) {
+        dsp.processRank(src, dst, rankSize, rankIndex, tapFor());
+        std::swap(src, dst);
+    }
+
+    // Base Filtering (Mandatory Box Blur)
+    if (held != &k_blur) {
+        dsp.process(src, dst, k_blur, tapFor());
+        std::swap(src, dst);
+    }
+
+    // Extended Filtering
+    if (gaussian && held != &k_gaussian) {
+        dsp.process(src, dst, k_gaussian, tapFor());
+        std::swap(src, dst);
+    }
+    if (sharpen) {
+        dsp.process(src, dst, k_sharpen, tapFor());
+        std::swap(src, dst);
+    }
+    if (sobel) {
+        dsp.processSobel(src, dst, tapFor());
+        std::swap(src, dst);
+    }
+
+    if (spare) {
+        *spare = dst; // Handed back for the held pass
+    } else {
+        delete dst; // Cleanup the swap buffer
+    }
+    return src;
+}
+
+void FilterChain::runPlanes(ConvolutionEngine& dsp, FrameBuffer<GrayPixel>* planes[3]) const {
+    int w = planes[0]->getWidth();
+    int h = planes[0]->getHeight();
+
+    // Ping-pong buffer management, one pair per plane
+    FrameBuffer<GrayPixel>* src[3] = { planes[0], planes[1], planes[2] };
+    FrameBuffer<GrayPixel>* dst[3];
+    for (int c = 0; c < 3; c++) {
+        dst[c] = new FrameBuffer<GrayPixel>(w, h);
+    }
+
+    auto swapPlanes = [&]() {
+        for (int c = 0; c < 3; c++) std::swap(src[c], dst[c]);
+    };
+
+    // Impulse Noise Removal (per plane: rank order is not linear)
+    if (rankSize > 0) {
+        for (int c = 0; c < 3; c++) dsp.processRank(src[c], dst[c], rankSize, rankIndex);
+        swapPlanes();
+    }
+
+    // Base Filtering (Mandatory Box Blur)
+    dsp.processPlanes(src, dst, k_blur);
+    swapPlanes();
+
+    // Extended Filtering
+    if (gaussian) {
+        dsp.processPlanes(src, dst, k_gaussian);
+        swapPlanes();
+    }
+    if (sharpen) {
+        dsp.processPlanes(src, dst, k_sharpen);
+        swapPlanes();
+    }
+    if (sobel) {
+        for (int c = 0; c < 3; c++) dsp.processSobel(src[c], dst[c]);
+        swapPlanes();
+    }
+
+    for (int c = 0; c < 3; c++) {
+        delete dst[c]; // Cleanup the swap buffers
+        planes[c] = src[c];
+    }
+}
\ No newline at end of file
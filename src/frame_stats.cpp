@@ -0,0 +1,174 @@
+#include "frame_stats.h"
+#include <cstring>
+#include <iomanip>
+
+void FrameStats::reset() {
+    std::memset(histogram, 0, sizeof(histogram));
+    minVal = 255;
+    maxVal = 0;
+    sum = 0;
+    count = 0;
+}
+
+void FrameStats::merge(const FrameStats& other) {
+    for (int i = 0; i < 256; i++) {
+        histogram[i] += other.histogram[i];
+    }
+    if (other.count > 0) {
+        if (other.minVal < minVal) minVal = other.minVal;
+        if (other.maxVal > maxVal) maxVal = other.maxVal;
+    }
+    sum += other.sum;
+    count += other.count;
+}
+
+StatsAccumulator::StatsAccumulator() : minVal(255), maxVal(0), sum(0), count(0) {
+    std::memset(banks, 0, sizeof(banks));
+}
+
+void StatsAccumulator::tally(const GrayPixel* row, int n) {
+    // 1. HISTOGRAM (scatter, one bank per lane)
+    int x = 0;
+    for (; x + 3 < n; x += 4) {
+        banks[0][row[x]]++;
+        banks[1][row[x + 1]]++;
+        banks[2][row[x + 2]]++;
+        banks[3][row[x + 3]]++;
+    }
+    for (; x < n; x++) {
+        banks[0][row[x]]++;
+    }
+
+    // 2. MIN / MAX / SUM (pure reductions, vectorizable)
+    uint8_t mn = minVal;
+    uint8_t mx = maxVal;
+    uint32_t rowSum = 0;
+    for (x = 0; x < n; x++) {
+        mn = (row[x] < mn) ? row[x] : mn;
+        mx = (row[x] > mx) ? row[x] : mx;
+        rowSum += row[x];
+    }
+
+    minVal = mn;
+    maxVal = mx;
+    sum += rowSum;
+    count += n;
+}
+
+void StatsAccumulator::flushInto(FrameStats& stats) const {
+    FrameStats local;
+    for (int i = 0; i < 256; i++) {
+        local.histogram[i] = banks[0][i] + banks[1][i] + banks[2][i] + banks[3][i];
+    }
+    local.minVal = minVal;
+    local.maxVal = maxVal;
+    local.sum = sum;
+    local.count = count;
+
+    stats.merge(local);
+}
+
+void tapRow(GrayPixel* row, int n, const OutputTap* tap, StatsAccumulator& acc) {
+    if (!tap || n <= 0) return;
+
+    if (tap->stats) {
+        acc.tally(row, n);
+    }
+    if (tap->lut) {
+        for (int x = 0; x < n; x++) {
+            row[x] = tap->lut[row[x]];
+        }
+    }
+}
+
+void buildStretchLUT(const FrameStats& stats, GrayPixel lut[256]) {
+    // Identity until proven otherwise
+    for (int i = 0; i < 256; i++) {
+        lut[i] = (GrayPixel)i;
+    }
+    if (stats.count == 0) return;
+
+    // Clip 1% on each side so a few outliers don't pin the range
+    uint32_t clip = stats.count / 100;
+    uint32_t cumulative = 0;
+    int lo = 0;
+    for (; lo < 255; lo++) {
+        cumulative += stats.histogram[lo];
+        if (cumulative > clip) break;
+    }
+
+    cumulative = 0;
+    int hi = 255;
+    for (; hi > 0; hi--) {
+        cumulative += stats.histogram[hi];
+        if (cumulative > clip) break;
+    }
+
+    if (hi <= lo) return; // Flat frame: nothing to stretch
+
+    // Fixed-point remap: (v - lo) * 255 / (hi - lo), clamped
+    for (int i = 0; i < 256; i++) {
+        int32_t v = ((int32_t)(i - lo) * 255) / (hi - lo);
+        if (v < 0) v = 0;
+        if (v > 255) v = 255;
+        lut[i] = (GrayPixel)v;
+    }
+}
+
+void remapStats(const FrameStats& in, const GrayPixel lut[256], FrameStats& out) {
+    out.reset();
+    for (int v = 0; v < 256; v++) {
+        uint32_t n = in.histogram[v];
+        if (n == 0) continue;
+
+        GrayPixel m = lut[v];
+        out.histogram[m] += n;
+        if (m < out.minVal) out.minVal = m;
+        if (m > out.maxVal) out.maxVal = m;
+        out.sum += (uint64_t)m * n;
+    }
+    out.count = in.count;
+}
+
+void remapBorder(GrayPixel* frame, int w, int h, const GrayPixel lut[256]) {
+    if (w <= 0 || h <= 0) return;
+
+    // Top and bottom rows
+    for (int x = 0; x < w; x++) {
+        frame[x] = lut[frame[x]];
+        if (h > 1) frame[(h - 1) * w + x] = lut[frame[(h - 1) * w + x]];
+    }
+
+    // Left and right columns (corners are already done)
+    for (int y = 1; y < h - 1; y++) {
+        frame[y * w] = lut[frame[y * w]];
+        if (w > 1) frame[y * w + w - 1] = lut[frame[y * w + w - 1]];
+    }
+}
+
+static void writeStatsBlock(std::ostream& os, const FrameStats& s) {
+    os << "{\"count\": " << s.count
+       << ", \"min\": " << (s.count ? (int)s.minVal : 0)
+       << ", \"max\": " << (s.count ? (int)s.maxVal : 0)
+       << ", \"sum\": " << s.sum
+       << ", \"mean\": " << std::fixed << std::setprecision(3) << s.mean()
+       << ", \"histogram\": [";
+    for (int i = 0; i < 256; i++) {
+        os << (i ? ", " : "") << s.histogram[i];
+    }
+    os << "]}";
+}
+
+void writeStatsJSON(std::ostream& os, int frame, const FrameStatsRecord& record) {
+    os << "{\"frame\": " << frame << ", \"isp\": ";
+    writeStatsBlock(os, record.isp);
+
+    // "dsp" always describes the written frame; the LUT's input is kept alongside
+    os << ", \"dsp\": ";
+    writeStatsBlock(os, record.lutApplied ? record.written : record.dsp);
+    if (record.lutApplied) {
+        os << ", \"dsp_pre_lut\": ";
+        writeStatsBlock(os, record.dsp);
+    }
+    os << "}" << std::endl;
+}
@@ -1,19 +1,12 @@
 #include "frame_writer.h"
 #include <fstream>
+#include <vector>
 
-void FrameWriter::writeBMP(const char* filename, FrameBuffer<GrayPixel>* buffer) {
-        std::ofstream file(filename, std::ios::binary);
-        if (!file) {
-            std::cerr << "Error: Output file creation failed." << std::endl;
-            return;
-        }
-
-        int width = buffer->getWidth();
-        int height = buffer->getHeight();
+// 54-byte BMP header for a 24-bit, bottom-up frame
+static void writeHeader(std::ofstream& file, int width, int height) {
         int paddingSize = (4 - (width * 3) % 4) % 4;
         int fileSize = 54 + (width * 3 + paddingSize) * height;
 
-        // --- WRITE HEADER ---
         unsigned char header[54] = {0};
         header[0] = 'B'; header[1] = 'M';
         *(int*)&header[2] = fileSize;
@@ -25,6 +18,21 @@ void FrameWriter::writeBMP(const char* filename, FrameBuffer<GrayPixel>* buffer)
         *(short*)&header[28] = 24; // We write 24-bit for compatibility
 
         file.write((char*)header, 54);
+}
+
+void FrameWriter::writeBMP(const char* filename, FrameBuffer<GrayPixel>* buffer) {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: Output file creation failed." << std::endl;
+            return;
+        }
+
+        int width = buffer->getWidth();
+        int height = buffer->getHeight();
+        int paddingSize = (4 - (width * 3) % 4) % 4;
+
+        // --- WRITE HEADER ---
+        writeHeader(file, width, height);
 
         // --- WRITE PIXEL DATA ---
         unsigned char pad[3] = {0, 0, 0};
@@ -44,4 +52,41 @@ void FrameWriter::writeBMP(const char* filename, FrameBuffer<GrayPixel>* buffer)
         #ifdef DEBUG
         std::cout << "Output Writer: Saved " << filename << std::endl;
         #endif
+};
+
+void FrameWriter::writeBMP(const char* filename, FrameBuffer<GrayPixel>* const planes[3]) {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: Output file creation failed." << std::endl;
+            return;
+        }
+
+        int width = planes[0]->getWidth();
+        int height = planes[0]->getHeight();
+        int paddingSize = (4 - (width * 3) % 4) % 4;
+
+        // --- WRITE HEADER ---
+        writeHeader(file, width, height);
+
+        // --- WRITE PIXEL DATA ---
+        // Re-interleave the R/G/B planes into one BGR line per burst
+        std::vector<unsigned char> line(width * 3 + paddingSize, 0);
+
+        for (int y = 0; y < height; y++) {
+            const GrayPixel* r = planes[0]->getRawData() + y * width;
+            const GrayPixel* g = planes[1]->getRawData() + y * width;
+            const GrayPixel* b = planes[2]->getRawData() + y * width;
+
+            for (int x = 0; x < width; x++) {
+                line[x * 3 + 0] = b[x];
+                line[x * 3 + 1] = g[x];
+                line[x * 3 + 2] = r[x];
+            }
+            file.write((char*)line.data(), line.size());
+        }
+
+        file.close();
+        #ifdef DEBUG
+        std::cout << "Output Writer: Saved " << filename << " (color)" << std::endl;
+        #endif
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "kernel_analyzer.h"
+
+#ifdef USE_FIXED_POINT
+
+// Smallest two's-complement width that holds [lo, hi]
+static int signedBits(int64_t lo, int64_t hi) {
+    int bits = 1;
+    while (bits < 64) {
+        int64_t maxVal = (int64_t(1) << (bits - 1)) - 1;
+        int64_t minVal = -maxVal - 1;
+        if (lo >= minVal && hi <= maxVal) break;
+        bits++;
+    }
+    return bits;
+}
+
+AccumulatorProfile KernelAnalyzer::analyze(const Kernel& k) const {
+    AccumulatorProfile p;
+    p.effective = k;
+
+    // 1. EXACT RESCALE
+    // (w * 2^n) * x >> (s + n) == (w * x) >> s for an arithmetic shift,
+    // so common power-of-two factors are folded into the shift for free.
+    bool allEven = true;
+    while (p.effective.shift > 0 && allEven) {
+        for (int ky = 0; ky < 3; ky++) {
+            for (int kx = 0; kx < 3; kx++) {
+                if (p.effective.weights[ky][kx] % 2 != 0) allEven = false;
+            }
+        }
+        if (!allEven) break;
+
+        for (int ky = 0; ky < 3; ky++) {
+            for (int kx = 0; kx < 3; kx++) {
+                p.effective.weights[ky][kx] /= 2;
+            }
+        }
+        p.effective.shift--;
+    }
+
+    // 2. WORST-CASE RANGE
+    // Each tap sees an independent pixel in [0, 255]: positive weights push
+    // the maximum, negative weights push the minimum. Every partial sum is
+    // bounded by the same range, whatever order the MAC accumulates in.
+    int64_t posSum = 0;
+    int64_t negSum = 0;
+    for (int ky = 0; ky < 3; ky++) {
+        for (int kx = 0; kx < 3; kx++) {
+            int16_t wgt = p.effective.weights[ky][kx];
+            if (wgt > 0) posSum += wgt;
+            else         negSum += wgt;
+        }
+    }
+
+    int64_t lo = negSum * 255;
+    int64_t hi = posSum * 255;
+
+    // The accumulator also holds the shifted, biased result before the clamp
+    int64_t outLo = (lo >> p.effective.shift) + p.effective.bias;
+    int64_t outHi = (hi >> p.effective.shift) + p.effective.bias;
+    if (outLo < lo) lo = outLo;
+    if (outHi > hi) hi = outHi;
+
+    p.bitsRequired = signedBits(lo, hi);
+
+    // 3. WIDTH SELECTION
+    if (p.bitsRequired <= 16)      p.accWidth = 16;
+    else if (p.bitsRequired <= 32) p.accWidth = 32;
+    else                           p.accWidth = 0; // Overflows the MAC
+
+    p.accMin = (p.accWidth != 0) ? (int32_t)lo : INT32_MIN;
+    p.accMax = (p.accWidth != 0) ? (int32_t)hi : INT32_MAX;
+
+    return p;
+}
+
+#endif // USE_FIXED_POINT
@@ -11,7 +11,8 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <algorithm> // For std::swap
+#include <cstdlib>   // For std::atoi
+#include <fstream>
 
 // Hardware Module Headers
 #include "image_types.h"
@@ -21,6 +22,11 @@
 #include "color_converter.h"
 #include "convolution.h"
 #include "kernel.h"
+#include "kernel_analyzer.h"
+#include "pyramid.h"
+#include "frame_stats.h"
+#include "filter_chain.h"
+#include "autotuner.h"
 
 // --- PIPELINE REGISTERS (Inter-Stage Latches) ---
 // In hardware, these pointers represent the physical wires/buses 
@@ -28,6 +34,11 @@
 FrameBuffer<Pixel>* reg_RawData = nullptr;      
 FrameBuffer<GrayPixel>* reg_GrayData = nullptr;     
 FrameBuffer<GrayPixel>* reg_ProcessedData = nullptr;
+std::vector<FrameBuffer<GrayPixel>*> reg_PyramidData; // Decimated levels (1/2, 1/4, ...)
+FrameBuffer<GrayPixel>* reg_PlaneData[3] = { nullptr, nullptr, nullptr };      // Color path: R, G, B planes
+FrameBuffer<GrayPixel>* reg_ProcessedPlanes[3] = { nullptr, nullptr, nullptr };
+FrameStatsRecord* reg_GrayStats = nullptr;      // ISP statistics, latched with reg_GrayData
+FrameStatsRecord* reg_ProcessedStats = nullptr; // ISP + DSP statistics, latched with reg_ProcessedData
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
@@ -37,6 +48,16 @@ int main(int argc, char* argv[]) {
         std::cout << "  -gaussian    Apply Gaussian Blur" << std::endl;
         std::cout << "  -sharpen     Apply Sharpening" << std::endl;
         std::cout << "  -sobel       Apply Sobel Edge Detection" << std::endl;
+        std::cout << "  -median      Apply 3x3 Median Filter (salt-and-pepper removal)" << std::endl;
+        std::cout << "  -median5     Apply 5x5 Median Filter" << std::endl;
+        std::cout << "  -erode       Apply 3x3 Min Filter (Erosion)" << std::endl;
+        std::cout << "  -dilate      Apply 3x3 Max Filter (Dilation)" << std::endl;
+        std::cout << "  -pyramid N   Also output N Gaussian pyramid levels (1/2, 1/4, ...)" << std::endl;
+        std::cout << "  -pyramid-only N  Output only the N pyramid levels (no full-resolution frame)" << std::endl;
+        std::cout << "  -stats       Write per-frame histogram/min/max/mean to stats_<n>.json" << std::endl;
+        std::cout << "  -autocontrast Stretch contrast using the previous frame's statistics" << std::endl;
+        std::cout << "  -color       Keep color: filter R, G, B planes and write 24-bit color output" << std::endl;
+        std::cout << "  --autotune   Time candidate execution plans and save the winner to " << TUNING_FILE << std::endl;
         std::cout << "\nNote: Box Blur is always applied as the base filter." << std::endl;
         return 0;
     }
@@ -46,11 +67,21 @@ int main(int argc, char* argv[]) {
     FrameWriter writer;
     ColorConverter isp;
     ConvolutionEngine dsp;
+    PyramidEngine pyr;
 
     // 2. Configuration & State
     bool enable_gaussian = true; 
     bool enable_sharpen  = true; 
     bool enable_sobel    = true; 
+    int pyramid_levels   = 0;    // 0 = full resolution output only
+    bool write_full_res  = true; // false = pyramid levels only (-pyramid-only)
+    int rank_size        = 0;    // Rank filter window (0 = disabled)
+    int rank_index       = 0;    // Position in the sorted window
+    std::string rank_name;
+    bool enable_stats    = false;
+    bool enable_contrast = false;
+    bool enable_autotune = false;
+    bool enable_color    = false;
     std::vector<std::string> inputFiles;
 
     // 3. CLI Argument Parsing
@@ -58,7 +89,8 @@ int main(int argc, char* argv[]) {
     bool filter_flag_seen = false;
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
-        if (arg == "-gaussian" || arg == "-sharpen" || arg == "-sobel") {
+        if (arg == "-gaussian" || arg == "-sharpen" || arg == "-sobel" ||
+            arg == "-median" || arg == "-median5" || arg == "-erode" || arg == "-dilate") {
             filter_flag_seen = true;
             break;
         }
@@ -73,6 +105,22 @@ int main(int argc, char* argv[]) {
         if (arg == "-gaussian") enable_gaussian = true;
         else if (arg == "-sharpen") enable_sharpen = true;
         else if (arg == "-sobel")   enable_sobel = true;
+        else if (arg == "-median")  { rank_size = 3; rank_index = 4;  rank_name = "MEDIAN 3x3"; }
+        else if (arg == "-median5") { rank_size = 5; rank_index = 12; rank_name = "MEDIAN 5x5"; }
+        else if (arg == "-erode")   { rank_size = 3; rank_index = 0;  rank_name = "MIN 3x3 (ERODE)"; }
+        else if (arg == "-dilate")  { rank_size = 3; rank_index = 8;  rank_name = "MAX 3x3 (DILATE)"; }
+        else if (arg == "-stats")        enable_stats = true;
+        else if (arg == "-autocontrast") enable_contrast = true;
+        else if (arg == "--autotune" || arg == "-autotune") enable_autotune = true;
+        else if (arg == "-color")        enable_color = true;
+        else if (arg == "-pyramid" || arg == "-pyramid-only") {
+            pyramid_levels = (i + 1 < argc) ? std::atoi(argv[++i]) : 0;
+            if (pyramid_levels < 1) {
+                std::cerr << "Error: " << arg << " expects a level count >= 1." << std::endl;
+                return 1;
+            }
+            write_full_res = (arg == "-pyramid");
+        }
         else if (arg[0] != '-') {
             inputFiles.push_back(arg); 
         }
@@ -94,10 +142,105 @@ int main(int argc, char* argv[]) {
     #endif
     << std::endl;
     std::cout << " [CONF] Processing " << totalFrames << " frame(s)." << std::endl;
+    std::cout << " [CONF] Path:     " << (enable_color ? "COLOR (planar R/G/B)" : "GRAYSCALE") << std::endl;
+
+    // Statistics, auto-contrast and the pyramid are luminance features
+    if (enable_color && (enable_stats || enable_contrast || pyramid_levels > 0)) {
+        std::cout << " [CONF] Note: -stats, -autocontrast and -pyramid are grayscale-only; ignored in color mode." << std::endl;
+        enable_stats = enable_contrast = false;
+        pyramid_levels = 0;
+        write_full_res = true;
+    }
+
+    // Statistics describe the written full-resolution frame
+    if (!write_full_res && (enable_stats || enable_contrast)) {
+        std::cout << " [CONF] Note: -pyramid-only writes no full-resolution frame; -stats and -autocontrast ignored." << std::endl;
+        enable_stats = enable_contrast = false;
+    }
     std::cout << " [CONF] Box Blur: ALWAYS ON" << std::endl;
     std::cout << " [CONF] Gaussian: " << (enable_gaussian ? "ENABLED" : "DISABLED") << std::endl;
     std::cout << " [CONF] Sharpen:  " << (enable_sharpen ? "ENABLED" : "DISABLED") << std::endl;
     std::cout << " [CONF] Sobel:    " << (enable_sobel ? "ENABLED" : "DISABLED") << std::endl;
+    std::cout << " [CONF] Rank:     " << (rank_size > 0 ? rank_name : "DISABLED") << std::endl;
+    std::cout << " [CONF] Stats:    " << (enable_stats ? "ENABLED" : "DISABLED") << std::endl;
+    std::cout << " [CONF] Contrast: " << (enable_contrast ? "AUTO (previous frame)" : "DISABLED") << std::endl;
+    if (pyramid_levels > 0) {
+        std::cout << " [CONF] Pyramid:  " << pyramid_levels << " level(s)"
+                  << (write_full_res ? "" : ", full-resolution output OFF") << std::endl;
+    } else {
+        std::cout << " [CONF] Pyramid:  DISABLED" << std::endl;
+    }
+
+    // Stage-3 chain as configured above
+    FilterChain chain;
+    chain.rankSize  = rank_size;
+    chain.rankIndex = rank_index;
+    chain.gaussian  = enable_gaussian;
+    chain.sharpen   = enable_sharpen;
+    chain.sobel     = enable_sobel;
+
+    // A trailing blur doubles as the pyramid's anti-alias filter: it runs once,
+    // as the first REDUCE, instead of at full resolution and again on decimation
+    const Kernel* pyramid_first = (pyramid_levels > 0) ? chain.lastBlur() : nullptr;
+    if (pyramid_first != nullptr) {
+        std::cout << " [CONF] Pyramid:  " << (chain.gaussian ? "Gaussian" : "Box Blur")
+                  << " fused into level-1 REDUCE" << std::endl;
+    }
+
+    #ifdef USE_FIXED_POINT
+    // Load-time MAC sizing: analyze every enabled kernel before the first clock.
+    // Kernels that could overflow the accumulator are rejected here; the width
+    // actually used is reported once the execution plan is known.
+    KernelAnalyzer analyzer;
+    struct MacStage { const char* name; const Kernel* kernel; bool enabled; bool planned; AccumulatorProfile profile; };
+    // Without full-resolution output, the fused blur only runs inside the pyramid
+    bool held_blur   = (pyramid_first != nullptr) && !write_full_res;
+    bool blur_on     = !(held_blur && !enable_gaussian);
+    bool gaussian_on = enable_gaussian && !held_blur;
+
+    MacStage macStages[] = {
+        { "Box Blur", &k_blur,     blur_on,            true,  AccumulatorProfile() },
+        { "Gaussian", &k_gaussian, gaussian_on,        true,  AccumulatorProfile() },
+        { "Sharpen ", &k_sharpen,  enable_sharpen,     true,  AccumulatorProfile() },
+        // Pyramid is not planned: always narrowest
+        { "Pyramid ", pyramid_first ? pyramid_first : &k_gaussian, pyramid_levels > 0, false, AccumulatorProfile() },
+        { "Pyr L2+ ", &k_gaussian, pyramid_levels > 1 && pyramid_first && !enable_gaussian, false, AccumulatorProfile() }
+    };
+    const size_t macStageCount = sizeof(macStages) / sizeof(macStages[0]);
+
+    for (size_t i = 0; i < macStageCount; i++) {
+        if (!macStages[i].enabled) continue;
+
+        macStages[i].profile = analyzer.analyze(*macStages[i].kernel);
+        if (macStages[i].profile.accWidth == 0) {
+            std::cerr << "Error: " << macStages[i].name << " kernel overflows the 32-bit accumulator." << std::endl;
+            return 1;
+        }
+    }
+    #endif
+
+    // Execution planner: per-machine profiles are loaded automatically and
+    // consulted whenever the input resolution changes
+    AutoTuner tuner;
+    tuner.loadProfiles(TUNING_FILE);
+    int planW = 0;
+    int planH = 0;
+    std::cout << " [CONF] Host CPU: " << tuner.cpuModel() << std::endl;
+
+    // Statistics are gathered whenever something consumes them
+    bool collect_stats = enable_stats || enable_contrast;
+
+    // What the tuner must time besides the passes (and the profile key)
+    TuningWorkload workload;
+    workload.planar       = enable_color;
+    workload.holdLastBlur = (pyramid_first != nullptr) && !write_full_res;
+    workload.stats        = collect_stats;
+    workload.lut          = enable_contrast;
+
+    // Auto-contrast LUT, rebuilt from each frame's DSP statistics and applied
+    // to the next frame on its final DSP write-back (no extra frame sweep)
+    GrayPixel contrastLUT[256];
+    bool contrastReady = false;
 
     int clockCycle = 0;
     int inputIdx = 0;
@@ -118,7 +261,25 @@ int main(int argc, char* argv[]) {
             #ifdef DEBUG
             std::cout << " [STG 4] Writing " << outName << std::endl;
             #endif
-            writer.writeBMP(outName.c_str(), reg_ProcessedData);
+            if (write_full_res) {
+                writer.writeBMP(outName.c_str(), reg_ProcessedData);
+            }
+
+            if (enable_stats && reg_ProcessedStats != nullptr) {
+                std::string statsName = "stats_" + std::to_string(outputIdx) + ".json";
+                std::ofstream statsFile(statsName.c_str());
+                writeStatsJSON(statsFile, outputIdx, *reg_ProcessedStats);
+            }
+            delete reg_ProcessedStats;
+            reg_ProcessedStats = nullptr;
+
+            // Pyramid levels share the write-back burst with the base frame
+            for (size_t lvl = 0; lvl < reg_PyramidData.size(); lvl++) {
+                std::string lvlName = "output_" + std::to_string(outputIdx) + "_L" + std::to_string(lvl + 1) + ".bmp";
+                writer.writeBMP(lvlName.c_str(), reg_PyramidData[lvl]);
+                delete reg_PyramidData[lvl];
+            }
+            reg_PyramidData.clear();
             
             // Simulates freeing the hardware buffer after DMA completion
             delete reg_ProcessedData; 
@@ -126,56 +287,157 @@ int main(int argc, char* argv[]) {
             outputIdx++;
         }
 
+        if (reg_ProcessedPlanes[0] != nullptr) {
+            std::string outName = "output_" + std::to_string(outputIdx) + ".bmp";
+            #ifdef DEBUG
+            std::cout << " [STG 4] Writing " << outName << " (color)" << std::endl;
+            #endif
+            writer.writeBMP(outName.c_str(), reg_ProcessedPlanes);
+
+            for (int c = 0; c < 3; c++) {
+                delete reg_ProcessedPlanes[c];
+                reg_ProcessedPlanes[c] = nullptr;
+            }
+            outputIdx++;
+        }
+
         // --- STAGE 3: DSP ACCELERATOR (Convolution) ---
         if (reg_GrayData != nullptr) {
             #ifdef DEBUG
             std::cout << " [STG 3] Running Filter Pipeline" << std::endl;
             #endif
-            int w = reg_GrayData->getWidth();
-            int h = reg_GrayData->getHeight();
-            
-            // Ping-pong buffer management within the accelerator
-            FrameBuffer<GrayPixel>* src = reg_GrayData; 
-            FrameBuffer<GrayPixel>* dst = new FrameBuffer<GrayPixel>(w, h);
-
-            // Base Filtering (Mandatory Box Blur)
-            dsp.process(src, dst, k_blur);
-            std::swap(src, dst); 
-
-            // Extended Filtering
-            if (enable_gaussian) { 
-                dsp.process(src, dst, k_gaussian); 
-                std::swap(src, dst); 
+            // Output tap: statistics and contrast LUT ride on the final pass only
+            OutputTap finalTap = { nullptr, nullptr };
+            if (reg_GrayStats != nullptr) finalTap.stats = &reg_GrayStats->dsp;
+            if (enable_contrast && contrastReady) finalTap.lut = contrastLUT;
+
+            FrameBuffer<GrayPixel>* src = nullptr;
+
+            if (pyramid_first != nullptr) {
+                // Fused: the chain stops before its trailing blur, which runs
+                // as the level-1 REDUCE (and at full resolution only if written)
+                FrameBuffer<GrayPixel>* spare = nullptr;
+                FrameBuffer<GrayPixel>* pre = chain.run(dsp, reg_GrayData, nullptr, true, &spare);
+                reg_PyramidData = pyr.process(pre, pyramid_levels, k_gaussian, pyramid_first, finalTap.lut);
+
+                if (write_full_res) {
+                    // Same ping-pong buffer the unfused chain would write: identical frame
+                    dsp.process(pre, spare, *pyramid_first, &finalTap);
+                    src = spare;
+                    delete pre;
+                } else {
+                    delete spare;
+                    src = pre; // Still latched: it carries the frame through write-back
+                }
+            } else {
+                src = chain.run(dsp, reg_GrayData, &finalTap);
             }
-            if (enable_sharpen) { 
-                dsp.process(src, dst, k_sharpen); 
-                std::swap(src, dst); 
+
+            // The LUT rode on the final pass; finish the border ring it never
+            // writes, and derive the written frame's statistics from the tap's
+            if (finalTap.lut != nullptr) {
+                remapBorder(src->getRawData(), src->getWidth(), src->getHeight(), finalTap.lut);
+                if (reg_GrayStats != nullptr) {
+                    remapStats(reg_GrayStats->dsp, finalTap.lut, reg_GrayStats->written);
+                    reg_GrayStats->lutApplied = true;
+                }
+            }
+
+            // Decimating Gaussian: blur is only evaluated at retained pixels
+            if (pyramid_levels > 0 && pyramid_first == nullptr) {
+                reg_PyramidData = pyr.process(src, pyramid_levels, k_gaussian);
             }
-            if (enable_sobel) { 
-                dsp.processSobel(src, dst); 
-                std::swap(src, dst); 
+
+            // This frame's (pre-LUT) statistics program the LUT for the next one
+            if (enable_contrast && reg_GrayStats != nullptr) {
+                buildStretchLUT(reg_GrayStats->dsp, contrastLUT);
+                contrastReady = true;
             }
 
-            delete dst; // Cleanup the swap buffer
             reg_GrayData = nullptr; 
             reg_ProcessedData = src; // Latch result into the output register
+            reg_ProcessedStats = reg_GrayStats;
+            reg_GrayStats = nullptr;
+        }
+
+        if (reg_PlaneData[0] != nullptr) {
+            #ifdef DEBUG
+            std::cout << " [STG 3] Running Filter Pipeline (color planes)" << std::endl;
+            #endif
+            chain.runPlanes(dsp, reg_PlaneData);
+
+            for (int c = 0; c < 3; c++) {
+                reg_ProcessedPlanes[c] = reg_PlaneData[c]; // Latch into the output register
+                reg_PlaneData[c] = nullptr;
+            }
         }
 
         // --- STAGE 2: ISP (Color Space Conversion) ---
         if (reg_RawData != nullptr) {
             #ifdef DEBUG
-            std::cout << " [STG 2] Converting RGB -> Gray" << std::endl;
+            std::cout << " [STG 2] " << (enable_color ? "Splitting RGB -> R/G/B planes" : "Converting RGB -> Gray") << std::endl;
             #endif
-            FrameBuffer<GrayPixel>* grayOut = new FrameBuffer<GrayPixel>(
-                reg_RawData->getWidth(), 
-                reg_RawData->getHeight()
-            );
-            
-            isp.process(reg_RawData, grayOut);
+            int w = reg_RawData->getWidth();
+            int h = reg_RawData->getHeight();
+
+            // Reprogram the datapath when the resolution changes. Stage 3 has
+            // already run this cycle, so the new plan starts with this frame.
+            if (w != planW || h != planH) {
+                ExecutionPlan plan;
+                const char* source = "default";
+
+                if (enable_autotune) {
+                    std::cout << " [PLAN] Autotuning " << w << "x" << h << " " << workload.key()
+                              << " (" << chain.key() << ")..." << std::endl;
+                    plan = tuner.tune(w, h, chain, workload);
+                    tuner.saveProfiles(TUNING_FILE);
+                    source = "autotuned";
+                } else if (tuner.lookup(w, h, chain, workload, plan)) {
+                    source = "profile";
+                }
+
+                isp.setPlan(plan);
+                dsp.setPlan(plan);
+                planW = w;
+                planH = h;
+
+                std::cout << " [PLAN] " << w << "x" << h << ": " << plan.threads << " thread(s), stripe ";
+                if (plan.stripeHeight > 0) std::cout << plan.stripeHeight;
+                else                       std::cout << "auto";
+                std::cout << ", 16-bit MAC " << (plan.narrowAcc ? "allowed" : "off")
+                          << " (" << source << ")" << std::endl;
+
+                #ifdef USE_FIXED_POINT
+                // Width the engines will run with under this plan
+                for (size_t i = 0; i < macStageCount; i++) {
+                    if (!macStages[i].enabled) continue;
+
+                    const AccumulatorProfile& profile = macStages[i].profile;
+                    int width = (profile.accWidth == 16 && (plan.narrowAcc || !macStages[i].planned)) ? 16 : 32;
+                    std::cout << " [MAC]  " << macStages[i].name << ": " << width << "-bit accumulator ("
+                              << profile.bitsRequired << " bits used)" << std::endl;
+                }
+                #endif
+            }
+
+            if (enable_color) {
+                // Color path: split into planes instead of collapsing to gray
+                for (int c = 0; c < 3; c++) {
+                    reg_PlaneData[c] = new FrameBuffer<GrayPixel>(w, h);
+                }
+                isp.processPlanar(reg_RawData, reg_PlaneData);
+            } else {
+                FrameBuffer<GrayPixel>* grayOut = new FrameBuffer<GrayPixel>(w, h);
+
+                FrameStatsRecord* stats = collect_stats ? new FrameStatsRecord() : nullptr;
+                isp.process(reg_RawData, grayOut, stats ? &stats->isp : nullptr);
+
+                reg_GrayData = grayOut; // Latch into DSP register
+                reg_GrayStats = stats;
+            }
             
             delete reg_RawData; // Drain the raw input buffer
             reg_RawData = nullptr;
-            reg_GrayData = grayOut; // Latch into DSP register
         }
 
         // --- STAGE 1: INPUT (Frame Reader) ---
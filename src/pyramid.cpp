@@ -0,0 +1,152 @@
+#include "pyramid.h"
+#include "kernel_analyzer.h"
+#include <iostream>
+
+// Edge replication (the BRAM address generator clamps instead of wrapping)
+static inline int clampIndex(int i, int n) {
+    if (i < 0) return 0;
+    if (i >= n) return n - 1;
+    return i;
+}
+
+#ifdef USE_FIXED_POINT
+// Single output pixel of the decimating MAC (columns c0, c1, c2 of three rows)
+template <typename AccT>
+static inline GrayPixel reducePixel(const GrayPixel* const rows[3], int c0, int c1, int c2, const Kernel& k) {
+    AccT sum = 0;
+
+    for (int ky = 0; ky < 3; ky++) {
+        sum += (AccT)(rows[ky][c0] * k.weights[ky][0]);
+        sum += (AccT)(rows[ky][c1] * k.weights[ky][1]);
+        sum += (AccT)(rows[ky][c2] * k.weights[ky][2]);
+    }
+
+    // Apply Bit Shift (Hardware Division)
+    if (k.shift > 0) {
+        sum = (AccT)(sum >> k.shift);
+    }
+
+    sum += k.bias;
+
+    // Clamp
+    if (sum < 0) sum = 0;
+    if (sum > 255) sum = 255;
+
+    return (GrayPixel)sum;
+}
+
+template <typename AccT>
+static void reduceRows(const GrayPixel* in, int w, int h, GrayPixel* out, int ow, int oh, const Kernel& k) {
+    // With ow = w/2 and oh = h/2 the right/bottom taps (2*o + 1) always land
+    // inside the frame; only the left column and top row need clamping.
+    for (int oy = 0; oy < oh; oy++) {
+        int y = 2 * oy;
+        const GrayPixel* rows[3] = {
+            in + clampIndex(y - 1, h) * w,
+            in + y * w,
+            in + (y + 1) * w
+        };
+        GrayPixel* dstRow = out + oy * ow;
+
+        // Left edge
+        dstRow[0] = reducePixel<AccT>(rows, 0, 0, 1, k);
+
+        // Interior: only every other input column is ever filtered
+        for (int ox = 1; ox < ow; ox++) {
+            int x = 2 * ox;
+            dstRow[ox] = reducePixel<AccT>(rows, x - 1, x, x + 1, k);
+        }
+    }
+}
+#endif
+
+void PyramidEngine::reduce(FrameBuffer<GrayPixel>* input, FrameBuffer<GrayPixel>* output, const Kernel& k) {
+    int w = input->getWidth();
+    int h = input->getHeight();
+    int ow = output->getWidth();
+    int oh = output->getHeight();
+
+    // Hardware Constraint Check
+    if (ow != w / 2 || oh != h / 2) {
+        std::cerr << "Error: Pyramid level dimensions mismatch!" << std::endl;
+        return;
+    }
+
+    #ifdef USE_FIXED_POINT
+        // --- FIXED POINT MODE ---
+        KernelAnalyzer analyzer;
+        AccumulatorProfile profile = analyzer.analyze(k);
+
+        if (profile.accWidth == 0) {
+            std::cerr << "DSP Error: Kernel accumulator exceeds 32 bits!" << std::endl;
+            return;
+        }
+
+        #ifdef DEBUG
+        std::cout << " [PYR] Fixed-Point Reduce " << w << "x" << h << " -> " << ow << "x" << oh
+                  << " (" << profile.accWidth << "-bit accumulator)..." << std::endl;
+        #endif
+
+        if (profile.accWidth == 16) {
+            reduceRows<int16_t>(input->getRawData(), w, h, output->getRawData(), ow, oh, profile.effective);
+        } else {
+            reduceRows<int32_t>(input->getRawData(), w, h, output->getRawData(), ow, oh, profile.effective);
+        }
+
+    #else
+        // --- FLOATING POINT MODE ---
+        #ifdef DEBUG
+        std::cout << " [PYR] Floating-Point Reduce " << w << "x" << h << " -> " << ow << "x" << oh << "..." << std::endl;
+        #endif
+
+        for (int oy = 0; oy < oh; oy++) {
+            for (int ox = 0; ox < ow; ox++) {
+                float sum = 0.0f;
+
+                for (int ky = -1; ky <= 1; ky++) {
+                    for (int kx = -1; kx <= 1; kx++) {
+                        uint8_t val = input->getPixel(clampIndex(2 * ox + kx, w), clampIndex(2 * oy + ky, h));
+                        sum += (float)val * k.weights[ky + 1][kx + 1];
+                    }
+                }
+
+                // Apply Scale (Float Multiply)
+                sum = (sum * k.scale) + k.bias;
+
+                // Clamp
+                if (sum < 0.0f) sum = 0.0f;
+                if (sum > 255.0f) sum = 255.0f;
+
+                output->setPixel(ox, oy, (uint8_t)sum);
+            }
+        }
+    #endif
+}
+
+std::vector<FrameBuffer<GrayPixel>*> PyramidEngine::process(FrameBuffer<GrayPixel>* input, int levels, const Kernel& k,
+                                                            const Kernel* first, const GrayPixel* firstLut) {
+    std::vector<FrameBuffer<GrayPixel>*> pyramid;
+    FrameBuffer<GrayPixel>* src = input;
+
+    for (int level = 1; level <= levels; level++) {
+        int ow = src->getWidth() / 2;
+        int oh = src->getHeight() / 2;
+        if (ow < 1 || oh < 1) break;
+
+        // Each level is reduced from the previous one, so total work is
+        // 1/4 + 1/16 + ... of a full-frame pass
+        FrameBuffer<GrayPixel>* dst = new FrameBuffer<GrayPixel>(ow, oh);
+        reduce(src, dst, (level == 1 && first) ? *first : k);
+
+        if (level == 1 && firstLut) {
+            GrayPixel* px = dst->getRawData();
+            for (int i = 0; i < ow * oh; i++) {
+                px[i] = firstLut[px[i]];
+            }
+        }
+        pyramid.push_back(dst);
+        src = dst;
+    }
+
+    return pyramid;
+}